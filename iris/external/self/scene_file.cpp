@@ -0,0 +1,416 @@
+#include "scene_file.h"
+
+#include "stellaris/models/solar_system.h"
+
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(SceneFile::Header) == 32, "scene header layout changed");
+static_assert(sizeof(SceneFile::Spring) == 56, "scene spring layout changed");
+
+namespace {
+
+    constexpr int ArrayCount = 13;
+
+    struct BodyInit {
+        double m;
+        double p_x, p_y, p_z;
+        double v_x, v_y, v_z;
+    };
+
+    // Order of the per-body blocks in the binary form
+    std::array<double *, ArrayCount> initialArrays(SystemState *state) {
+        return {
+            state->m,
+            state->p_x, state->p_y, state->p_z,
+            state->v_x, state->v_y, state->v_z,
+            state->theta_x, state->theta_y, state->theta_z,
+            state->v_theta_x, state->v_theta_y, state->v_theta_z
+        };
+    }
+
+    std::array<const double *, ArrayCount> initialArrays(const SystemState *state) {
+        return {
+            state->m,
+            state->p_x, state->p_y, state->p_z,
+            state->v_x, state->v_y, state->v_z,
+            state->theta_x, state->theta_y, state->theta_z,
+            state->v_theta_x, state->v_theta_y, state->v_theta_z
+        };
+    }
+
+    // Reads the rest of a line as finite decimal numbers, fails on any token that is not one
+    bool readNumbers(std::istringstream &in, std::vector<double> &values) {
+        std::string token;
+        while (in >> token) {
+            // strtod would also take hex floats
+            if (token.find_first_of("xX") != std::string::npos) {
+                return false;
+            }
+
+            char *end = nullptr;
+            const double value = std::strtod(token.c_str(), &end);
+            if (end != token.c_str() + token.size() || !std::isfinite(value)) {
+                return false;
+            }
+            values.push_back(value);
+        }
+        return true;
+    }
+
+    bool toIndex(double value, int32_t &index) {
+        if (value != std::floor(value) || value < -1.0 || value > (double)INT32_MAX) {
+            return false;
+        }
+        index = (int32_t)value;
+        return true;
+    }
+
+    // Solvers divide by the mass, and a negative step would run the scene backwards
+    bool validMass(double m) {
+        return std::isfinite(m) && m > 0.0;
+    }
+
+    bool validStep(double dt) {
+        return std::isfinite(dt) && dt >= 0.0;
+    }
+
+    // A spring pulls on a body, either towards another body or towards its fixed anchor (-1)
+    bool validSprings(const std::vector<SceneFile::Spring> &springs, size_t bodyCount) {
+        for (const SceneFile::Spring &spring : springs) {
+            if (spring.body < 0 || (size_t)spring.body >= bodyCount) {
+                return false;
+            }
+            if (spring.other != -1 && (spring.other < 0 || (size_t)spring.other >= bodyCount)) {
+                return false;
+            }
+            if (spring.other == spring.body) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Only initial conditions are stored, everything the solver derives starts at zero
+    void clearDerived(SystemState *state) {
+        const size_t bytes = sizeof(double) * state->n;
+        std::memset(state->a_theta_x, 0, bytes);
+        std::memset(state->a_theta_y, 0, bytes);
+        std::memset(state->a_theta_z, 0, bytes);
+        std::memset(state->a_x, 0, bytes);
+        std::memset(state->a_y, 0, bytes);
+        std::memset(state->a_z, 0, bytes);
+        std::memset(state->f_x, 0, bytes);
+        std::memset(state->f_y, 0, bytes);
+        std::memset(state->f_z, 0, bytes);
+        std::memset(state->t_x, 0, bytes);
+        std::memset(state->t_y, 0, bytes);
+        std::memset(state->t_z, 0, bytes);
+    }
+
+    void reallocate(SystemState *state, int bodyCount) {
+        // resize() never shrinks, start over so n matches the scene exactly
+        state->destroy();
+        if (bodyCount > 0) {
+            state->resize(bodyCount, 0);
+        }
+    }
+
+    void fillState(SystemState *state, const std::vector<BodyInit> &bodies) {
+        reallocate(state, (int)bodies.size());
+
+        for (int i = 0; i < state->n; ++i) {
+            const BodyInit &b = bodies[i];
+            state->m[i] = b.m;
+            state->p_x[i] = b.p_x;
+            state->p_y[i] = b.p_y;
+            state->p_z[i] = b.p_z;
+            state->v_x[i] = b.v_x;
+            state->v_y[i] = b.v_y;
+            state->v_z[i] = b.v_z;
+            state->theta_x[i] = state->theta_y[i] = state->theta_z[i] = 0.0;
+            state->v_theta_x[i] = state->v_theta_y[i] = state->v_theta_z[i] = 0.0;
+        }
+
+        clearDerived(state);
+    }
+
+    // Bodies are laid out on the x axis in SI units, each on a circular orbit in the x-z plane
+    void appendSolarSystem(std::vector<BodyInit> &bodies) {
+        const std::vector<stellaris::models::planet> catalog = stellaris::models::solarSystem();
+        const size_t first = bodies.size();
+
+        for (const stellaris::models::planet &planet : catalog) {
+            BodyInit body = {planet.mass, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+            if (planet.orbits != planet.type) {
+                // solarSystem() is ordered by type, so the parent is already placed
+                const BodyInit &parent = bodies[first + planet.orbits];
+                body.p_x = parent.p_x + planet.distance * 1000.0;
+                body.p_y = parent.p_y;
+                body.p_z = parent.p_z;
+                body.v_x = parent.v_x;
+                body.v_y = parent.v_y;
+                body.v_z = parent.v_z + planet.meterPerSecond;
+            }
+
+            bodies.push_back(body);
+        }
+    }
+
+}
+
+SceneFile::SceneFile() {
+    /* void */
+}
+
+SceneFile::~SceneFile() {
+    destroy();
+}
+
+bool SceneFile::load(const std::string &path) {
+    char magic[sizeof(Magic)] = {};
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.read(magic, sizeof(magic))) {
+        return loadText(path);
+    }
+    file.close();
+
+    if (std::memcmp(magic, Magic, sizeof(Magic)) == 0) {
+        return loadBinary(path);
+    }
+    return loadText(path);
+}
+
+bool SceneFile::loadText(const std::string &path) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    std::vector<BodyInit> bodies;
+    std::vector<Spring> parsedSprings;
+    double dt = 0.0;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        const size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+
+        std::istringstream in(line);
+        std::string directive;
+        if (!(in >> directive)) {
+            continue;
+        }
+
+        if (directive == "preset") {
+            std::string name;
+            std::string extra;
+            if (!(in >> name) || name != "solar_system" || (in >> extra)) {
+                return false;
+            }
+            appendSolarSystem(bodies);
+            continue;
+        }
+
+        std::vector<double> values;
+        if (!readNumbers(in, values)) {
+            return false;
+        }
+
+        if (directive == "dt") {
+            if (values.size() != 1 || !validStep(values[0])) {
+                return false;
+            }
+            dt = values[0];
+        } else if (directive == "body") {
+            // Velocity is optional, but it is all three components or none
+            if ((values.size() != 4 && values.size() != 7) || !validMass(values[0])) {
+                return false;
+            }
+            BodyInit body = {values[0], values[1], values[2], values[3], 0.0, 0.0, 0.0};
+            if (values.size() == 7) {
+                body.v_x = values[4];
+                body.v_y = values[5];
+                body.v_z = values[6];
+            }
+            bodies.push_back(body);
+        } else if (directive == "spring") {
+            Spring spring;
+            if (values.size() != 8 || !toIndex(values[0], spring.body) || !toIndex(values[1], spring.other)) {
+                return false;
+            }
+            spring.anchor_x = values[2];
+            spring.anchor_y = values[3];
+            spring.anchor_z = values[4];
+            spring.k = values[5];
+            spring.damping = values[6];
+            spring.rest_length = values[7];
+            parsedSprings.push_back(spring);
+        } else {
+            return false;
+        }
+    }
+
+    if (!validSprings(parsedSprings, bodies.size())) {
+        return false;
+    }
+
+    fillState(&state, bodies);
+    state.dt = dt;
+    springs = std::move(parsedSprings);
+
+    return true;
+}
+
+bool SceneFile::loadBinary(const std::string &path) {
+#if defined(_WIN32)
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+
+    std::vector<unsigned char> buffer((size_t)file.tellg());
+    file.seekg(0);
+    if (!file.read((char *)buffer.data(), (std::streamsize)buffer.size())) {
+        return false;
+    }
+
+    return fromBuffer(buffer.data(), buffer.size());
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(Header)) {
+        ::close(fd);
+        return false;
+    }
+
+    const size_t size = (size_t)info.st_size;
+    void *mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+
+    // Blocks are read front to back exactly once
+    ::madvise(mapped, size, MADV_SEQUENTIAL);
+
+    const bool result = fromBuffer((const unsigned char *)mapped, size);
+    ::munmap(mapped, size);
+
+    return result;
+#endif
+}
+
+bool SceneFile::fromBuffer(const unsigned char *data, size_t size) {
+    if (size < sizeof(Header)) {
+        return false;
+    }
+
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != Version) {
+        return false;
+    }
+
+    const size_t n = header.bodyCount;
+    const size_t expected = sizeof(Header)
+            + sizeof(double) * n * ArrayCount
+            + sizeof(Spring) * header.springCount;
+    if (size != expected || n > (size_t)INT32_MAX) {
+        return false;
+    }
+
+    const unsigned char *springBlock = data + sizeof(Header) + sizeof(double) * n * ArrayCount;
+    std::vector<Spring> loadedSprings(header.springCount);
+    std::memcpy((void *)loadedSprings.data(), (const void *)springBlock, sizeof(Spring) * header.springCount);
+    if (!validSprings(loadedSprings, n) || !validStep(header.dt)) {
+        return false;
+    }
+
+    // The mass block comes first, check it in place before anything is allocated
+    const unsigned char *massBlock = data + sizeof(Header);
+    for (size_t i = 0; i < n; ++i) {
+        double m;
+        std::memcpy(&m, massBlock + sizeof(double) * i, sizeof(double));
+        if (!validMass(m)) {
+            return false;
+        }
+    }
+
+    reallocate(&state, (int)n);
+
+    const unsigned char *block = data + sizeof(Header);
+    if (n > 0) {
+        for (double *target : initialArrays(&state)) {
+            std::memcpy((void *)target, (const void *)block, sizeof(double) * n);
+            block += sizeof(double) * n;
+        }
+        clearDerived(&state);
+    }
+
+    springs = std::move(loadedSprings);
+
+    state.dt = header.dt;
+
+    return true;
+}
+
+bool SceneFile::writeBinary(const std::string &path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    Header header;
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.bodyCount = (uint32_t)state.n;
+    header.springCount = (uint32_t)springs.size();
+    header.reserved = 0;
+    header.dt = state.dt;
+
+    file.write((const char *)&header, sizeof(Header));
+
+    if (state.n > 0) {
+        for (const double *source : initialArrays(&state)) {
+            file.write((const char *)source, (std::streamsize)(sizeof(double) * state.n));
+        }
+    }
+
+    file.write((const char *)springs.data(), (std::streamsize)(sizeof(Spring) * springs.size()));
+
+    return (bool)file;
+}
+
+void SceneFile::loadSolarSystem() {
+    std::vector<BodyInit> bodies;
+    appendSolarSystem(bodies);
+
+    fillState(&state, bodies);
+    springs.clear();
+}
+
+void SceneFile::destroy() {
+    state.destroy();
+    springs.clear();
+}
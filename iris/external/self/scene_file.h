@@ -0,0 +1,66 @@
+#ifndef PLUSSIM_SCENE_FILE_H
+#define PLUSSIM_SCENE_FILE_H
+
+#include "system_state.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Scene description: bodies with their initial conditions plus the springs between them.
+//
+// Text form (authoring), one directive per line, '#' starts a comment:
+//   dt <seconds>
+//   body <mass> <p_x> <p_y> <p_z> [<v_x> <v_y> <v_z>]
+//   spring <body> <other|-1> <anchor_x> <anchor_y> <anchor_z> <k> <damping> <rest_length>
+//   preset solar_system
+//
+// Binary form (compiled): a fixed header followed by one block per SystemState array.
+// Loading does no per-value parsing: after the header, spring and mass checks each block is
+// copied out of the mapped file. For large scenes allocating and zeroing the SystemState
+// arrays costs more than the copies themselves.
+class SceneFile {
+public:
+    struct Spring {
+        int32_t body;       // Body the spring pulls on
+        int32_t other;      // Second body, or -1 for the fixed anchor below
+        double anchor_x;
+        double anchor_y;
+        double anchor_z;
+        double k;
+        double damping;
+        double rest_length;
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t bodyCount;
+        uint32_t springCount;
+        uint32_t reserved;
+        double dt;
+    };
+
+    static constexpr char Magic[8] = {'P', 'S', 'S', 'C', 'E', 'N', 'E', '\0'};
+    static constexpr uint32_t Version = 1;
+
+public:
+    SceneFile();
+    ~SceneFile();
+
+    bool load(const std::string &path);     // Picks the form from the file's magic
+    bool loadText(const std::string &path);
+    bool loadBinary(const std::string &path);
+    bool writeBinary(const std::string &path) const;
+
+    void loadSolarSystem();
+    void destroy();
+
+    SystemState state;
+    std::vector<Spring> springs;
+
+protected:
+    bool fromBuffer(const unsigned char *data, size_t size);
+};
+
+#endif //PLUSSIM_SCENE_FILE_H
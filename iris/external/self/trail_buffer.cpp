@@ -0,0 +1,145 @@
+#include "trail_buffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+TrailBuffer::TrailBuffer() {
+    m_n = 0;
+    m_capacity = 0;
+}
+
+TrailBuffer::~TrailBuffer() {
+    /* void */
+}
+
+bool TrailBuffer::resize(int bodyCount, int capacity) {
+    if (bodyCount < 0 || capacity < 1) {
+        return false;
+    }
+
+    m_n = bodyCount;
+    m_capacity = capacity;
+
+    const size_t points = (size_t)bodyCount * (size_t)capacity;
+    m_x.assign(points, 0.0f);
+    m_y.assign(points, 0.0f);
+    m_z.assign(points, 0.0f);
+    m_head.assign(bodyCount, 0);
+    m_count.assign(bodyCount, 0);
+
+    m_dir_x.assign(bodyCount, 0.0f);
+    m_dir_y.assign(bodyCount, 0.0f);
+    m_dir_z.assign(bodyCount, 0.0f);
+    m_reach.assign(bodyCount, 0.0f);
+
+    return true;
+}
+
+void TrailBuffer::clear() {
+    std::fill(m_head.begin(), m_head.end(), 0);
+    std::fill(m_count.begin(), m_count.end(), 0);
+}
+
+size_t TrailBuffer::index(int body, int i) const {
+    return (size_t)body * (size_t)m_capacity + (size_t)((m_head[body] + i) % m_capacity);
+}
+
+void TrailBuffer::append(int body, double x, double y, double z) {
+    // The current tip becomes the committed point the next chord starts from
+    if (m_count[body] > 0) {
+        const size_t tip = index(body, m_count[body] - 1);
+        const double d_x = x - m_x[tip];
+        const double d_y = y - m_y[tip];
+        const double d_z = z - m_z[tip];
+        const double length = std::sqrt(d_x * d_x + d_y * d_y + d_z * d_z);
+
+        if (length > 0.0) {
+            m_dir_x[body] = (float)(d_x / length);
+            m_dir_y[body] = (float)(d_y / length);
+            m_dir_z[body] = (float)(d_z / length);
+        } else {
+            m_dir_x[body] = m_dir_y[body] = m_dir_z[body] = 0.0f;
+        }
+        m_reach[body] = (float)length;
+    }
+
+    size_t slot;
+    if (m_count[body] < m_capacity) {
+        slot = index(body, m_count[body]);
+        ++m_count[body];
+    } else {
+        // Ring is full, the oldest point makes room
+        slot = index(body, 0);
+        m_head[body] = (m_head[body] + 1) % m_capacity;
+    }
+
+    m_x[slot] = (float)x;
+    m_y[slot] = (float)y;
+    m_z[slot] = (float)z;
+}
+
+void TrailBuffer::push(int body, double x, double y, double z, double tolerance) {
+    if (body < 0 || body >= m_n) {
+        return;
+    }
+
+    const int count = m_count[body];
+    if (count > 0) {
+        // Samples that barely leave the tip (a body at rest) are absorbed by it
+        const size_t tip = index(body, count - 1);
+        const double d_x = x - m_x[tip];
+        const double d_y = y - m_y[tip];
+        const double d_z = z - m_z[tip];
+        const double skipRadius = SKIP_RATIO * tolerance;
+        if (d_x * d_x + d_y * d_y + d_z * d_z <= skipRadius * skipRadius) {
+            return;
+        }
+    }
+
+    if (count < 2 || m_capacity < 3 || m_reach[body] <= 0.0f) {
+        append(body, x, y, z);
+        return;
+    }
+
+    const size_t tip = index(body, count - 1);
+    const size_t prev = index(body, count - 2);
+
+    // Sample relative to the last committed point, split along and across the first direction
+    const double r_x = x - m_x[prev];
+    const double r_y = y - m_y[prev];
+    const double r_z = z - m_z[prev];
+    const double along = r_x * m_dir_x[body] + r_y * m_dir_y[body] + r_z * m_dir_z[body];
+    const double o_x = r_x - along * m_dir_x[body];
+    const double o_y = r_y - along * m_dir_y[body];
+    const double o_z = r_z - along * m_dir_z[body];
+    const double offset = o_x * o_x + o_y * o_y + o_z * o_z;
+
+    // Every folded sample kept moving forward and stayed inside a corridor around that line,
+    // and so does the tip, so the stored chord is inside the corridor too. A folded sample is
+    // then at most corridor + corridor (+ skip radius for absorbed ones) = `tolerance` away.
+    const double corridor = CORRIDOR_RATIO * tolerance;
+    const double maxSegment = tolerance * MAX_SEGMENT_RATIO;
+    if (along >= m_reach[body] && along <= maxSegment && offset <= corridor * corridor) {
+        // Still straight enough on screen, move the tip instead of adding a point
+        m_x[tip] = (float)x;
+        m_y[tip] = (float)y;
+        m_z[tip] = (float)z;
+        m_reach[body] = (float)along;
+    } else {
+        append(body, x, y, z);
+    }
+}
+
+void TrailBuffer::push(const SystemState *state, double tolerance) {
+    const int n = std::min(state->n, m_n);
+    for (int i = 0; i < n; ++i) {
+        push(i, state->p_x[i], state->p_y[i], state->p_z[i], tolerance);
+    }
+}
+
+void TrailBuffer::getPoint(int body, int i, float &x, float &y, float &z) const {
+    const size_t slot = index(body, i);
+    x = m_x[slot];
+    y = m_y[slot];
+    z = m_z[slot];
+}
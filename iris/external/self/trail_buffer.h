@@ -0,0 +1,64 @@
+#ifndef PLUSSIM_TRAIL_BUFFER_H
+#define PLUSSIM_TRAIL_BUFFER_H
+
+#include "system_state.h"
+
+#include <cstddef>
+#include <vector>
+
+// Fixed-capacity position history per body. Memory is bodyCount * capacity points no matter
+// how long the simulation runs; once a body's ring is full its oldest point is overwritten.
+//
+// Samples are decimated on insert: the newest point is a provisional tip that gets moved
+// forward while every sample folded into it stays within `tolerance` of the stored segment,
+// so straight stretches cost one segment and curves keep their detail. Pass a tolerance
+// derived from the camera (world units per pixel) to keep the decimation in screen space.
+class TrailBuffer {
+public:
+    TrailBuffer();
+    ~TrailBuffer();
+
+    // Returns false and keeps the current buffer for a negative body count or capacity < 1
+    bool resize(int bodyCount, int capacity);
+    void clear();
+
+    void push(int body, double x, double y, double z, double tolerance);
+    void push(const SystemState *state, double tolerance);
+
+    int getBodyCount() const { return m_n; }
+    int getCapacity() const { return m_capacity; }
+    int getCount(int body) const { return m_count[body]; }
+
+    // i = 0 is the oldest stored point, getCount(body) - 1 the newest
+    void getPoint(int body, int i, float &x, float &y, float &z) const;
+
+protected:
+    size_t index(int body, int i) const;
+    void append(int body, double x, double y, double z);
+
+protected:
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_z;
+    std::vector<int> m_head;
+    std::vector<int> m_count;
+
+    // Per body: unit direction from the last committed point towards the first sample folded
+    // into the tip, and the furthest any folded sample has reached along it
+    std::vector<float> m_dir_x;
+    std::vector<float> m_dir_y;
+    std::vector<float> m_dir_z;
+    std::vector<float> m_reach;
+
+    int m_n;
+    int m_capacity;
+
+    // Longest segment a provisional tip may stretch to, in multiples of the tolerance
+    static constexpr double MAX_SEGMENT_RATIO = 64.0;
+    // Half-width of the corridor folded samples must stay in, in multiples of the tolerance
+    static constexpr double CORRIDOR_RATIO = 0.375;
+    // Samples closer than this to the tip are dropped, in multiples of the tolerance
+    static constexpr double SKIP_RATIO = 0.25;
+};
+
+#endif //PLUSSIM_TRAIL_BUFFER_H
@@ -114,6 +114,20 @@ void Cube::reset(double x, double y, double z) {
     m_state.t_x[0] = m_state.t_y[0] = m_state.t_z[0] = 0.0;
 }
 
+void Cube::setMotion(double v_x, double v_y, double v_z,
+                     double theta_x, double theta_y, double theta_z,
+                     double v_theta_x, double v_theta_y, double v_theta_z) {
+    m_state.v_x[0] = v_x;
+    m_state.v_y[0] = v_y;
+    m_state.v_z[0] = v_z;
+    m_state.theta_x[0] = theta_x;
+    m_state.theta_y[0] = theta_y;
+    m_state.theta_z[0] = theta_z;
+    m_state.v_theta_x[0] = v_theta_x;
+    m_state.v_theta_y[0] = v_theta_y;
+    m_state.v_theta_z[0] = v_theta_z;
+}
+
 void Cube::getPosition(double &x, double &y, double &z) const {
     x = m_state.p_x[0];
     y = m_state.p_y[0];
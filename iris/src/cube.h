@@ -16,6 +16,9 @@ public:
 
     void update(double dt);
     void reset(double x, double y, double z);
+    void setMotion(double v_x, double v_y, double v_z,
+                   double theta_x, double theta_y, double theta_z,
+                   double v_theta_x, double v_theta_y, double v_theta_z);
     void getPosition(double &x, double &y, double &z) const;
     void getSpringAnchor(double &x, double &y, double &z) const;
     double getSize() const { return m_size; }
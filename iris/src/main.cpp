@@ -1,12 +1,15 @@
 #include "raylib.h"
 #include "double_pendulum.h"
 #include <string>
+#include <cstdio>
 #include <cmath>
 #include <algorithm>
 #include "rlImGui.h"
 #include "imgui.h"
 
 #include "cube.h"
+#include "trails.h"
+#include "../external/self/scene_file.h"
 
 struct CameraControl {
     float angle;
@@ -51,7 +54,103 @@ void handleCamera(Camera3D& camera, CameraControl& camControl) {
     };
 }
 
-int main() {
+void printUsage(const char *program) {
+    std::fprintf(stderr,
+                 "usage: %s [scene]\n"
+                 "       %s --compile <scene.txt> <scene.bin>\n"
+                 "The viewer shows a single cube: the scene must hold exactly one body and at most\n"
+                 "one spring from that body to a fixed anchor. Its initial velocity and orientation are\n"
+                 "applied, and reapplied on reset. dt, when set, is used as a fixed step.\n",
+                 program, program);
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && std::string(argv[1]) == "--compile") {
+        // iris --compile <scene.txt> <scene.bin> turns an authored scene into the binary form
+        if (argc != 4) {
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        SceneFile scene;
+        if (!scene.loadText(argv[2])) {
+            std::fprintf(stderr, "%s: could not parse scene\n", argv[2]);
+            return 1;
+        }
+        if (!scene.writeBinary(argv[3])) {
+            std::fprintf(stderr, "%s: could not write scene\n", argv[3]);
+            return 1;
+        }
+        return 0;
+    }
+
+    if (argc > 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Defaults match scenes/spring_cube.scene
+    double start_x = 0.0;
+    double start_y = 10.0;
+    double start_z = 0.0;
+    float mass = 1.0f;
+    float spring_k = 50.0f;
+    float damping = 3.0f;
+    float rest_length = 4.0f;
+    float anchor_x = 0.0f;
+    float anchor_y = 15.0f;
+    float anchor_z = 0.0f;
+    bool has_spring = true;
+    double fixed_dt = 0.0; // 0 = step with the frame time
+    double start_v[3] = {0.0, 0.0, 0.0};
+    double start_theta[3] = {0.0, 0.0, 0.0};
+    double start_v_theta[3] = {0.0, 0.0, 0.0};
+
+    if (argc == 2) {
+        SceneFile scene;
+        if (!scene.load(argv[1])) {
+            std::fprintf(stderr, "%s: could not load scene\n", argv[1]);
+            return 1;
+        }
+
+        // Anything but one cube on one anchored spring cannot be shown here
+        const bool anchored = scene.springs.empty() ||
+                              (scene.springs[0].body == 0 && scene.springs[0].other == -1);
+        if (scene.state.n != 1 || scene.springs.size() > 1 || !anchored) {
+            std::fprintf(stderr, "%s: %d bodies and %zu springs, iris shows exactly one body "
+                                 "with at most one anchored spring\n",
+                         argv[1], scene.state.n, scene.springs.size());
+            return 1;
+        }
+
+        start_x = scene.state.p_x[0];
+        start_y = scene.state.p_y[0];
+        start_z = scene.state.p_z[0];
+        mass = (float)scene.state.m[0];
+        fixed_dt = scene.state.dt;
+
+        start_v[0] = scene.state.v_x[0];
+        start_v[1] = scene.state.v_y[0];
+        start_v[2] = scene.state.v_z[0];
+        start_theta[0] = scene.state.theta_x[0];
+        start_theta[1] = scene.state.theta_y[0];
+        start_theta[2] = scene.state.theta_z[0];
+        start_v_theta[0] = scene.state.v_theta_x[0];
+        start_v_theta[1] = scene.state.v_theta_y[0];
+        start_v_theta[2] = scene.state.v_theta_z[0];
+
+        has_spring = !scene.springs.empty();
+        if (has_spring) {
+            const SceneFile::Spring &spring = scene.springs[0];
+            spring_k = (float)spring.k;
+            damping = (float)spring.damping;
+            rest_length = (float)spring.rest_length;
+            anchor_x = (float)spring.anchor_x;
+            anchor_y = (float)spring.anchor_y;
+            anchor_z = (float)spring.anchor_z;
+        }
+    }
+
     const int screenWidth = 800;
     const int screenHeight = 600;
     
@@ -87,32 +186,41 @@ int main() {
 
     rlImGuiSetup(true);
 
-    // Initialize cube at (0, 10, 0) where Y=10 is the height - hangs below anchor
-    Cube cube(1.0, 0.0, 10.0, 0.0, 2.0);
-
-    // Set up spring: anchor at (0, 15, 0) - 15 units high (above cube)
-    // spring_k=50 (moderate stiffness), damping=3.0, rest_length=4.0
-    // The cube will hang down from the anchor point
-    cube.setSpring(0.0, 15.0, 0.0, 50.0, 3.0, 4.0);
+    // The cube hangs below the spring anchor
+    Cube cube(mass, start_x, start_y, start_z, 2.0);
+    cube.setMotion(start_v[0], start_v[1], start_v[2],
+                   start_theta[0], start_theta[1], start_theta[2],
+                   start_v_theta[0], start_v_theta[1], start_v_theta[2]);
+    if (has_spring) {
+        cube.setSpring(anchor_x, anchor_y, anchor_z, spring_k, damping, rest_length);
+    }
 
     // Configuration variables for ImGui
-    float mass = 1.0f;
-    float spring_k = 50.0f;
-    float damping = 3.0f;
-    float rest_length = 4.0f;
-    float anchor_x = 0.0f;
-    float anchor_y = 15.0f;
-    float anchor_z = 0.0f;
     float cube_size = 2.0f;
     int solver_type = 0; // 0 = Euler, 1 = RK4
     bool show_config = true;
+    bool show_trail = true;
+    int trail_length = 512;
+
+    // One trail per simulated body; the cube is body 0
+    TrailBuffer trail;
+    trail.resize(1, trail_length);
+
+    // Back to the scene's initial conditions
+    auto resetCube = [&]() {
+        cube.reset(start_x, start_y, start_z);
+        cube.setMotion(start_v[0], start_v[1], start_v[2],
+                       start_theta[0], start_theta[1], start_theta[2],
+                       start_v_theta[0], start_v_theta[1], start_v_theta[2]);
+        trail.clear();
+    };
 
     //DoublePendulum pendulum(2.0f, 2.0f, 0.2f, 0.2f, M_PI / 2.0f, M_PI / 2.0f, 0.05f);
 
     while (!WindowShouldClose()) {
         // Reset cube with R key
         if (IsKeyPressed(KEY_R)) {
-            cube.reset(0.0, 10.0, 0.0);
+            resetCube();
         }
 
         // Toggle config window with C key
@@ -122,18 +230,25 @@ int main() {
 
         handleCamera(camera, cameraControl);
 
-        double dt = GetFrameTime();
+        double dt = fixed_dt > 0.0 ? fixed_dt : GetFrameTime();
         cube.update(dt);
 
         double x, y, z;
         cube.getPosition(x, y, z);
 
+        // Keep roughly one trail segment per pixel of curvature on screen
+        trail.push(0, x, y, z, trailTolerance(camera, 1.0f));
+
         BeginDrawing();
         ClearBackground(RAYWHITE);
         {
             BeginMode3D(camera);
             DrawGrid(50, 1.0f);
 
+            if (show_trail) {
+                drawTrails(trail, MAROON);
+            }
+
             // Draw spring if enabled
             if (cube.hasSpring()) {
                 double anchor_x, anchor_y, anchor_z;
@@ -201,7 +316,17 @@ int main() {
 
             ImGui::Spacing();
             if (ImGui::Button("Reset Cube Position")) {
-                cube.reset(0.0, 10.0, 0.0);
+                resetCube();
+            }
+
+            ImGui::Spacing();
+            ImGui::Text("Trail");
+            ImGui::Separator();
+            ImGui::Checkbox("Show Trail", &show_trail);
+            // Resizing drops the history, so only do it once the slider is released
+            ImGui::SliderInt("Trail Length", &trail_length, 16, 4096);
+            if (ImGui::IsItemDeactivatedAfterEdit()) {
+                trail.resize(1, trail_length);
             }
 
             ImGui::Spacing();
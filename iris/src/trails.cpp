@@ -0,0 +1,46 @@
+#include "trails.h"
+#include "rlgl.h"
+#include <cmath>
+
+float trailTolerance(const Camera3D &camera, float pixels) {
+    const float dx = camera.target.x - camera.position.x;
+    const float dy = camera.target.y - camera.position.y;
+    const float dz = camera.target.z - camera.position.z;
+    const float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+    const float viewHeight = 2.0f * distance * std::tan(camera.fovy * 0.5f * DEG2RAD);
+    return pixels * viewHeight / (float)GetScreenHeight();
+}
+
+void pushTrail(TrailBuffer &trail, int body, Vector3 position, float tolerance) {
+    trail.push(body, position.x, position.y, position.z, tolerance);
+}
+
+void drawTrails(const TrailBuffer &trail, Color color) {
+    // rlgl flushes the batch by itself when it fills up, so the draw cost is bounded
+    // by bodyCount * capacity segments regardless of how long the run has been going.
+    rlBegin(RL_LINES);
+    for (int body = 0; body < trail.getBodyCount(); ++body) {
+        const int count = trail.getCount(body);
+        if (count < 2) {
+            continue;
+        }
+
+        float x0, y0, z0;
+        trail.getPoint(body, 0, x0, y0, z0);
+        for (int i = 1; i < count; ++i) {
+            float x1, y1, z1;
+            trail.getPoint(body, i, x1, y1, z1);
+
+            const unsigned char alpha = (unsigned char)(color.a * i / (count - 1));
+            rlColor4ub(color.r, color.g, color.b, alpha);
+            rlVertex3f(x0, y0, z0);
+            rlVertex3f(x1, y1, z1);
+
+            x0 = x1;
+            y0 = y1;
+            z0 = z1;
+        }
+    }
+    rlEnd();
+}
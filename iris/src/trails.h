@@ -0,0 +1,18 @@
+#ifndef PLUSSIM_TRAILS_H
+#define PLUSSIM_TRAILS_H
+
+#include "raylib.h"
+#include "../external/self/trail_buffer.h"
+
+// World-space size of `pixels` screen pixels at the camera's target distance.
+// Used as the decimation tolerance so trails keep the same on-screen detail at any zoom.
+float trailTolerance(const Camera3D &camera, float pixels);
+
+// Feed a single position, e.g. DoublePendulum::getPos2, into the trail of `body`.
+void pushTrail(TrailBuffer &trail, int body, Vector3 position, float tolerance);
+
+// Draws every trail in one line batch, fading from transparent (oldest) to `color` (newest).
+// Must be called between BeginMode3D and EndMode3D.
+void drawTrails(const TrailBuffer &trail, Color color);
+
+#endif //PLUSSIM_TRAILS_H
@@ -0,0 +1,276 @@
+#include "gtest/gtest.h"
+#include "scene_file.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+  std::string tempPath(const std::string &name) {
+    return (std::filesystem::temp_directory_path() / ("iris_test_" + name)).string();
+  }
+
+  std::string writeText(const std::string &name, const std::string &contents) {
+    const std::string path = tempPath(name);
+    std::ofstream file(path);
+    file << contents;
+    return path;
+  }
+
+  std::vector<char> readBytes(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+
+  void writeBytes(const std::string &path, const std::vector<char> &bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+  }
+
+  const char *CubeScene =
+      "# cube on a spring\n"
+      "dt 0.01\n"
+      "body 1.0 0.0 10.0 0.0   # at rest\n"
+      "body 2.0 1.0 2.0 3.0 4.0 5.0 6.0\n"
+      "\n"
+      "spring 0 -1 0.0 15.0 0.0 50.0 3.0 4.0\n"
+      "spring 0 1 0.0 0.0 0.0 10.0 1.0 2.0\n";
+
+  // Compiles the cube scene and returns the bytes of the binary form
+  std::vector<char> compiledCubeScene() {
+    SceneFile scene;
+    EXPECT_TRUE(scene.loadText(writeText("compile.scene", CubeScene)));
+    const std::string path = tempPath("compile.pscene");
+    EXPECT_TRUE(scene.writeBinary(path));
+    return readBytes(path);
+  }
+
+}
+
+TEST(SceneFile, ParsesText) {
+  SceneFile scene;
+  ASSERT_TRUE(scene.loadText(writeText("parse.scene", CubeScene)));
+
+  ASSERT_EQ(scene.state.n, 2);
+  EXPECT_DOUBLE_EQ(scene.state.dt, 0.01);
+
+  EXPECT_DOUBLE_EQ(scene.state.m[0], 1.0);
+  EXPECT_DOUBLE_EQ(scene.state.p_y[0], 10.0);
+  EXPECT_DOUBLE_EQ(scene.state.v_x[0], 0.0);
+  EXPECT_DOUBLE_EQ(scene.state.v_y[0], 0.0);
+  EXPECT_DOUBLE_EQ(scene.state.v_z[0], 0.0);
+
+  EXPECT_DOUBLE_EQ(scene.state.p_z[1], 3.0);
+  EXPECT_DOUBLE_EQ(scene.state.v_x[1], 4.0);
+  EXPECT_DOUBLE_EQ(scene.state.v_z[1], 6.0);
+  EXPECT_DOUBLE_EQ(scene.state.a_y[1], 0.0);
+
+  ASSERT_EQ(scene.springs.size(), 2u);
+  EXPECT_EQ(scene.springs[0].other, -1);
+  EXPECT_DOUBLE_EQ(scene.springs[0].anchor_y, 15.0);
+  EXPECT_DOUBLE_EQ(scene.springs[0].rest_length, 4.0);
+  EXPECT_EQ(scene.springs[1].other, 1);
+}
+
+TEST(SceneFile, ParsesPreset) {
+  SceneFile scene;
+  ASSERT_TRUE(scene.loadText(writeText("preset.scene", "body 1 0 0 0\npreset solar_system\n")));
+
+  // Sun through Pluto follow the hand-written body
+  ASSERT_EQ(scene.state.n, 12);
+  EXPECT_DOUBLE_EQ(scene.state.m[1], 1.989e30);
+  EXPECT_DOUBLE_EQ(scene.state.p_x[4], 149600000.0 * 1000.0);
+  EXPECT_DOUBLE_EQ(scene.state.v_z[4], 29780.0);
+  // The Moon is placed relative to the Earth
+  EXPECT_DOUBLE_EQ(scene.state.p_x[5], (149600000.0 + 384400.0) * 1000.0);
+  EXPECT_DOUBLE_EQ(scene.state.v_z[5], 29780.0 + 1022.0);
+}
+
+TEST(SceneFile, RejectsMalformedText) {
+  const char *bad[] = {
+      "body 1 0 0\n",                         // missing position component
+      "body 1 0 0 0 5\n",                     // partial velocity
+      "body 1 0 0 0 abc\n",                   // not a number
+      "body 1 0 0 0 1 2 3 4\n",               // trailing value
+      "body 0 0 10 0\n",                      // massless
+      "body -1 0 10 0\n",
+      "body nan 0 10 0\n",
+      "body 1 inf 10 0\n",
+      "body 1 0x1p3 10 0\n",                  // hex float
+      "body 1e999 0 10 0\n",                  // overflows to inf
+      "dt -1\n",
+      "dt nan\n",
+      "dt 0.1 0.2\n",
+      "preset moon_base\n",
+      "teleport 1 2 3\n",
+      "body 1 0 0 0\nspring 1 -1 0 0 0 1 1 1\n",   // body out of range
+      "body 1 0 0 0\nspring 0 -7 0 0 0 1 1 1\n",   // other below -1
+      "body 1 0 0 0\nspring 0 1 0 0 0 1 1 1\n",    // other out of range
+      "body 1 0 0 0\nspring 0 0 0 0 0 1 1 1\n",    // spring onto itself
+      "body 1 0 0 0\nspring 0.5 -1 0 0 0 1 1 1\n", // fractional index
+  };
+
+  for (const char *contents : bad) {
+    SceneFile scene;
+    EXPECT_FALSE(scene.loadText(writeText("bad.scene", contents))) << contents;
+  }
+}
+
+TEST(SceneFile, BinaryRoundTrip) {
+  SceneFile text;
+  ASSERT_TRUE(text.loadText(writeText("roundtrip.scene", CubeScene)));
+  // Orientation is part of the initial conditions even though the text form leaves it at zero
+  text.state.theta_z[1] = 0.5;
+  text.state.v_theta_x[0] = -1.5;
+
+  const std::string path = tempPath("roundtrip.pscene");
+  ASSERT_TRUE(text.writeBinary(path));
+
+  SceneFile binary;
+  ASSERT_TRUE(binary.load(path));
+  ASSERT_EQ(binary.state.n, text.state.n);
+  EXPECT_DOUBLE_EQ(binary.state.dt, text.state.dt);
+
+  const double *expected[] = {
+      text.state.m, text.state.p_x, text.state.p_y, text.state.p_z,
+      text.state.v_x, text.state.v_y, text.state.v_z,
+      text.state.theta_x, text.state.theta_y, text.state.theta_z,
+      text.state.v_theta_x, text.state.v_theta_y, text.state.v_theta_z};
+  const double *actual[] = {
+      binary.state.m, binary.state.p_x, binary.state.p_y, binary.state.p_z,
+      binary.state.v_x, binary.state.v_y, binary.state.v_z,
+      binary.state.theta_x, binary.state.theta_y, binary.state.theta_z,
+      binary.state.v_theta_x, binary.state.v_theta_y, binary.state.v_theta_z};
+  for (size_t a = 0; a < std::size(expected); ++a) {
+    for (int i = 0; i < text.state.n; ++i) {
+      EXPECT_DOUBLE_EQ(actual[a][i], expected[a][i]) << "array " << a << " body " << i;
+    }
+  }
+
+  ASSERT_EQ(binary.springs.size(), text.springs.size());
+  for (size_t i = 0; i < text.springs.size(); ++i) {
+    EXPECT_EQ(std::memcmp(&binary.springs[i], &text.springs[i], sizeof(SceneFile::Spring)), 0);
+  }
+}
+
+TEST(SceneFile, RejectsCorruptBinary) {
+  const std::vector<char> good = compiledCubeScene();
+  ASSERT_GT(good.size(), sizeof(SceneFile::Header));
+  const std::string path = tempPath("corrupt.pscene");
+
+  writeBytes(path, good);
+  SceneFile scene;
+  EXPECT_TRUE(scene.loadBinary(path));
+
+  std::vector<char> truncated(good.begin(), good.end() - 1);
+  writeBytes(path, truncated);
+  EXPECT_FALSE(scene.loadBinary(path));
+
+  std::vector<char> headerOnly(good.begin(), good.begin() + sizeof(SceneFile::Header) - 1);
+  writeBytes(path, headerOnly);
+  EXPECT_FALSE(scene.loadBinary(path));
+
+  std::vector<char> oversized = good;
+  oversized.push_back(0);
+  writeBytes(path, oversized);
+  EXPECT_FALSE(scene.loadBinary(path));
+
+  std::vector<char> wrongMagic = good;
+  wrongMagic[0] = 'X';
+  writeBytes(path, wrongMagic);
+  EXPECT_FALSE(scene.loadBinary(path));
+
+  std::vector<char> wrongVersion = good;
+  const uint32_t version = SceneFile::Version + 1;
+  std::memcpy(wrongVersion.data() + offsetof(SceneFile::Header, version), &version, sizeof(version));
+  writeBytes(path, wrongVersion);
+  EXPECT_FALSE(scene.loadBinary(path));
+
+  // The mass block directly follows the header
+  const double masses[] = {0.0, -1.0, NAN, INFINITY};
+  for (double mass : masses) {
+    std::vector<char> wrongMass = good;
+    std::memcpy(wrongMass.data() + sizeof(SceneFile::Header) + sizeof(double), &mass, sizeof(mass));
+    writeBytes(path, wrongMass);
+    EXPECT_FALSE(scene.loadBinary(path)) << mass;
+  }
+
+  const double steps[] = {-0.01, NAN, INFINITY};
+  for (double dt : steps) {
+    std::vector<char> wrongStep = good;
+    std::memcpy(wrongStep.data() + offsetof(SceneFile::Header, dt), &dt, sizeof(dt));
+    writeBytes(path, wrongStep);
+    EXPECT_FALSE(scene.loadBinary(path)) << dt;
+  }
+
+  // Claiming more bodies than the file holds must not read past the end
+  std::vector<char> wrongCount = good;
+  const uint32_t bodies = 1000000;
+  std::memcpy(wrongCount.data() + offsetof(SceneFile::Header, bodyCount), &bodies, sizeof(bodies));
+  writeBytes(path, wrongCount);
+  EXPECT_FALSE(scene.loadBinary(path));
+}
+
+TEST(SceneFile, RejectsBadSpringIndicesInBinary) {
+  const std::vector<char> good = compiledCubeScene();
+  const std::string path = tempPath("springs.pscene");
+  const size_t springs = good.size() - 2 * sizeof(SceneFile::Spring);
+
+  const int32_t badIndices[][2] = {{2, -1}, {-1, -1}, {0, -7}, {0, 2}, {1, 1}};
+  for (const auto &indices : badIndices) {
+    std::vector<char> bytes = good;
+    std::memcpy(bytes.data() + springs + offsetof(SceneFile::Spring, body), &indices[0], sizeof(int32_t));
+    std::memcpy(bytes.data() + springs + offsetof(SceneFile::Spring, other), &indices[1], sizeof(int32_t));
+    writeBytes(path, bytes);
+
+    SceneFile scene;
+    EXPECT_FALSE(scene.loadBinary(path)) << indices[0] << " " << indices[1];
+  }
+}
+
+TEST(SceneFile, RejectsMissingFile) {
+  SceneFile scene;
+  EXPECT_FALSE(scene.load(tempPath("does_not_exist.scene")));
+}
+
+TEST(SceneFile, LoadsMillionBodyScene) {
+  const int bodies = 1000000;
+  const std::string path = tempPath("million.pscene");
+
+  {
+    SceneFile scene;
+    scene.state.resize(bodies, 0);
+    for (int i = 0; i < bodies; ++i) {
+      scene.state.m[i] = 1.0 + i;
+      scene.state.p_x[i] = scene.state.p_y[i] = scene.state.p_z[i] = i;
+      scene.state.v_x[i] = scene.state.v_y[i] = scene.state.v_z[i] = -i;
+      scene.state.theta_x[i] = scene.state.theta_y[i] = scene.state.theta_z[i] = 0.0;
+      scene.state.v_theta_x[i] = scene.state.v_theta_y[i] = scene.state.v_theta_z[i] = 0.0;
+    }
+    ASSERT_TRUE(scene.writeBinary(path));
+  }
+
+  SceneFile scene;
+  const auto start = std::chrono::steady_clock::now();
+  ASSERT_TRUE(scene.load(path));
+  const auto end = std::chrono::steady_clock::now();
+
+  // Recorded rather than asserted, timings depend on the machine and the page cache
+  const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+  RecordProperty("load_ms", std::to_string(ms));
+  std::printf("1M-body binary scene loaded in %.1f ms\n", ms);
+
+  ASSERT_EQ(scene.state.n, bodies);
+  EXPECT_DOUBLE_EQ(scene.state.m[bodies - 1], bodies);
+  EXPECT_DOUBLE_EQ(scene.state.v_z[bodies - 1], -(bodies - 1));
+
+  std::filesystem::remove(path);
+}
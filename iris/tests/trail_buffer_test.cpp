@@ -0,0 +1,207 @@
+#include "gtest/gtest.h"
+#include "trail_buffer.h"
+#include "double_pendulum.h"
+#include "trails.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+  struct Sample {
+    double x, y, z;
+  };
+
+  double distanceToSegment(const Sample &p, const Sample &a, const Sample &b) {
+    const double ab_x = b.x - a.x, ab_y = b.y - a.y, ab_z = b.z - a.z;
+    const double ap_x = p.x - a.x, ap_y = p.y - a.y, ap_z = p.z - a.z;
+    const double length = ab_x * ab_x + ab_y * ab_y + ab_z * ab_z;
+    const double t = length > 0.0
+        ? std::clamp((ap_x * ab_x + ap_y * ab_y + ap_z * ab_z) / length, 0.0, 1.0)
+        : 0.0;
+    const double d_x = ap_x - t * ab_x, d_y = ap_y - t * ab_y, d_z = ap_z - t * ab_z;
+    return std::sqrt(d_x * d_x + d_y * d_y + d_z * d_z);
+  }
+
+  // Largest distance of any raw sample from the stored polyline of `body`
+  double maxError(const TrailBuffer &trail, int body, const std::vector<Sample> &samples) {
+    std::vector<Sample> stored;
+    for (int i = 0; i < trail.getCount(body); ++i) {
+      float x, y, z;
+      trail.getPoint(body, i, x, y, z);
+      stored.push_back({x, y, z});
+    }
+
+    double worst = 0.0;
+    for (const Sample &sample : samples) {
+      double best = stored.empty() ? INFINITY : std::sqrt(
+          (sample.x - stored[0].x) * (sample.x - stored[0].x) +
+          (sample.y - stored[0].y) * (sample.y - stored[0].y) +
+          (sample.z - stored[0].z) * (sample.z - stored[0].z));
+      for (size_t i = 1; i < stored.size(); ++i) {
+        best = std::min(best, distanceToSegment(sample, stored[i - 1], stored[i]));
+      }
+      worst = std::max(worst, best);
+    }
+    return worst;
+  }
+
+  std::vector<Sample> circle(double radius, double step, double angle) {
+    std::vector<Sample> samples;
+    for (double a = 0.0; a <= angle; a += step) {
+      samples.push_back({radius * std::cos(a), 0.0, radius * std::sin(a)});
+    }
+    return samples;
+  }
+
+  // Float storage adds a little rounding on top of the tolerance
+  constexpr double Slack = 1e-3;
+
+}
+
+TEST(TrailBuffer, RejectsBadSizes) {
+  TrailBuffer trail;
+  ASSERT_TRUE(trail.resize(2, 8));
+
+  EXPECT_FALSE(trail.resize(2, 0));
+  EXPECT_FALSE(trail.resize(2, -4));
+  EXPECT_FALSE(trail.resize(-1, 8));
+
+  EXPECT_EQ(trail.getBodyCount(), 2);
+  EXPECT_EQ(trail.getCapacity(), 8);
+}
+
+TEST(TrailBuffer, RingOverwritesOldest) {
+  TrailBuffer trail;
+  ASSERT_TRUE(trail.resize(1, 4));
+
+  // Zero tolerance keeps every distinct sample
+  for (int i = 0; i < 10; ++i) {
+    trail.push(0, i, (i % 2) * 1.0, 0.0, 0.0);
+    EXPECT_EQ(trail.getCount(0), std::min(i + 1, 4));
+  }
+
+  for (int i = 0; i < 4; ++i) {
+    float x, y, z;
+    trail.getPoint(0, i, x, y, z);
+    EXPECT_FLOAT_EQ(x, 6.0f + i);
+    EXPECT_FLOAT_EQ(y, (float)((6 + i) % 2));
+  }
+
+  trail.clear();
+  EXPECT_EQ(trail.getCount(0), 0);
+}
+
+TEST(TrailBuffer, BodyAtRestStoresOnePoint) {
+  TrailBuffer trail;
+  ASSERT_TRUE(trail.resize(1, 16));
+
+  for (int i = 0; i < 1000; ++i) {
+    trail.push(0, 1.0, 2.0, 3.0, 0.1);
+  }
+  EXPECT_EQ(trail.getCount(0), 1);
+}
+
+TEST(TrailBuffer, StraightLineIsDecimated) {
+  TrailBuffer trail;
+  ASSERT_TRUE(trail.resize(1, 1024));
+
+  for (int i = 0; i <= 1000; ++i) {
+    trail.push(0, i * 0.01, 0.0, 0.0, 1.0);
+  }
+  EXPECT_LE(trail.getCount(0), 3);
+
+  // The tip lags the body by less than the tolerance
+  float x, y, z;
+  trail.getPoint(0, trail.getCount(0) - 1, x, y, z);
+  EXPECT_NEAR(x, 10.0f, 1.0f);
+}
+
+TEST(TrailBuffer, CircleStaysWithinTolerance) {
+  const double tolerance = 1.0;
+
+  for (double radius : {5.0, 20.0, 50.0, 200.0}) {
+    const std::vector<Sample> samples = circle(radius, 0.001, 6.0);
+
+    TrailBuffer trail;
+    ASSERT_TRUE(trail.resize(1, (int)samples.size()));
+    for (const Sample &s : samples) {
+      trail.push(0, s.x, s.y, s.z, tolerance);
+    }
+
+    EXPECT_LE(maxError(trail, 0, samples), tolerance + Slack) << "radius " << radius;
+    // Still far fewer points than samples
+    EXPECT_LT(trail.getCount(0), (int)samples.size() / 10) << "radius " << radius;
+  }
+}
+
+TEST(TrailBuffer, FollowsSystemStateBodies) {
+  const int bodies = 3;
+  const double tolerance = 0.05;
+
+  SystemState state;
+  state.resize(bodies, 0);
+
+  TrailBuffer trail;
+  ASSERT_TRUE(trail.resize(bodies, 4096));
+
+  std::vector<std::vector<Sample>> samples(bodies);
+  for (int step = 0; step < 3000; ++step) {
+    const double t = step * 0.002;
+    for (int i = 0; i < bodies; ++i) {
+      const double radius = 1.0 + i;
+      state.p_x[i] = radius * std::cos(t * (i + 1));
+      state.p_y[i] = 0.5 * i * t;
+      state.p_z[i] = radius * std::sin(t * (i + 1));
+      samples[i].push_back({state.p_x[i], state.p_y[i], state.p_z[i]});
+    }
+    trail.push(&state, tolerance);
+  }
+
+  for (int i = 0; i < bodies; ++i) {
+    EXPECT_GT(trail.getCount(i), 2) << "body " << i;
+    EXPECT_LE(maxError(trail, i, samples[i]), tolerance + Slack) << "body " << i;
+  }
+
+  state.destroy();
+}
+
+TEST(TrailBuffer, IgnoresBodiesBeyondBuffer) {
+  SystemState state;
+  state.resize(3, 0);
+  for (int i = 0; i < 3; ++i) {
+    state.p_x[i] = state.p_y[i] = state.p_z[i] = i;
+  }
+
+  TrailBuffer trail;
+  ASSERT_TRUE(trail.resize(2, 8));
+  trail.push(&state, 0.1);
+  trail.push(5, 1.0, 1.0, 1.0, 0.1);
+
+  EXPECT_EQ(trail.getCount(0), 1);
+  EXPECT_EQ(trail.getCount(1), 1);
+
+  state.destroy();
+}
+
+TEST(TrailBuffer, FollowsDoublePendulumBob) {
+  const Vector3 origin = {0.0f, 10.0f, 0.0f};
+  const float tolerance = 0.02f;
+
+  DoublePendulum pendulum(2.0f, 2.0f, 0.2f, 0.2f, 1.5f, 1.5f, 0.01f);
+  TrailBuffer trail;
+  ASSERT_TRUE(trail.resize(1, 8192));
+
+  std::vector<Sample> samples;
+  for (int step = 0; step < 2000; ++step) {
+    pendulum.update();
+    const Vector3 bob = pendulum.getPos2(origin);
+    samples.push_back({bob.x, bob.y, bob.z});
+    pushTrail(trail, 0, bob, tolerance);
+  }
+
+  EXPECT_GT(trail.getCount(0), 10);
+  EXPECT_LT(trail.getCount(0), (int)samples.size());
+  EXPECT_LE(maxError(trail, 0, samples), tolerance + Slack);
+}
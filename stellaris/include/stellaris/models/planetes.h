@@ -1,19 +1,31 @@
+#pragma once
+
 #include <cstdint>
 namespace stellaris::models {
-  
+
   enum PlanetType {
     Sun,
+    Mercury,
+    Venus,
     Earth,
-    Moon
+    Moon,
+    Mars,
+    Jupiter,
+    Saturn,
+    Uranus,
+    Neptune,
+    Pluto
   };
   struct planet {
     PlanetType type;
-    int mass;
-    int radius;
-    int meterPerSecond;
-    float gravity;
-    float density;
-    uint32_t surfaceArea;
+    PlanetType orbits;    // Body this one circles (the Sun orbits itself)
+    double mass;          // kg
+    double radius;        // m
+    double distance;      // km to the body it orbits
+    int meterPerSecond;   // mean orbital speed
+    float gravity;        // m/s^2 at the surface
+    float density;        // kg/m^3
+    double surfaceArea;   // km^2, does not fit 32 bits for the gas giants
   };
-  
-}
\ No newline at end of file
+
+}
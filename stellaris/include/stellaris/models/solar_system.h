@@ -0,0 +1,12 @@
+#pragma once
+
+#include "stellaris/models/planetes.h"
+
+#include <vector>
+
+namespace stellaris::models {
+
+  // Sun, planets, Moon and Pluto ordered by PlanetType. Distances are the ones from notes.md.
+  std::vector<planet> solarSystem();
+
+}
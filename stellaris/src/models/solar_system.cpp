@@ -0,0 +1,22 @@
+#include "stellaris/models/solar_system.h"
+
+namespace stellaris::models {
+
+std::vector<planet> solarSystem() {
+    //  type     orbits  mass (kg)  radius (m)  distance (km)  v (m/s)  g      density  area (km^2)
+    return {
+        {Sun,     Sun,   1.989e30,  6.9570e8,   0.0,           0,       274.0f, 1408.0f, 6.09e12},
+        {Mercury, Sun,   3.301e23,  2.4397e6,   57900000.0,    47360,   3.70f,  5429.0f, 7.48e7},
+        {Venus,   Sun,   4.867e24,  6.0518e6,   108200000.0,   35020,   8.87f,  5243.0f, 4.60e8},
+        {Earth,   Sun,   5.972e24,  6.3710e6,   149600000.0,   29780,   9.81f,  5514.0f, 5.10e8},
+        {Moon,    Earth, 7.342e22,  1.7374e6,   384400.0,      1022,    1.62f,  3344.0f, 3.79e7},
+        {Mars,    Sun,   6.417e23,  3.3895e6,   227900000.0,   24070,   3.71f,  3934.0f, 1.44e8},
+        {Jupiter, Sun,   1.898e27,  6.9911e7,   778300000.0,   13070,   24.79f, 1326.0f, 6.14e10},
+        {Saturn,  Sun,   5.683e26,  5.8232e7,   1427000000.0,  9680,    10.44f, 687.0f,  4.27e10},
+        {Uranus,  Sun,   8.681e25,  2.5362e7,   2871000000.0,  6800,    8.87f,  1270.0f, 8.08e9},
+        {Neptune, Sun,   1.024e26,  2.4622e7,   4498000000.0,  5430,    11.15f, 1638.0f, 7.62e9},
+        {Pluto,   Sun,   1.303e22,  1.1883e6,   5900000000.0,  4740,    0.62f,  1854.0f, 1.77e7},
+    };
+}
+
+} // namespace stellaris::models
@@ -0,0 +1,23 @@
+#include "gtest/gtest.h"
+#include "stellaris/models/solar_system.h"
+
+using namespace stellaris::models;
+
+TEST(SolarSystem, OrderedByType) {
+  const std::vector<planet> bodies = solarSystem();
+
+  ASSERT_EQ(bodies.size(), static_cast<size_t>(Pluto) + 1);
+  for (size_t i = 0; i < bodies.size(); ++i) {
+    EXPECT_EQ(bodies[i].type, static_cast<PlanetType>(i));
+  }
+}
+
+TEST(SolarSystem, DistancesFromNotes) {
+  const std::vector<planet> bodies = solarSystem();
+
+  EXPECT_DOUBLE_EQ(bodies[Earth].distance, 149600000.0);
+  EXPECT_EQ(bodies[Moon].orbits, Earth);
+  EXPECT_DOUBLE_EQ(bodies[Moon].distance, 384400.0);
+  EXPECT_DOUBLE_EQ(bodies[Pluto].distance, 5900000000.0);
+  EXPECT_GT(bodies[Jupiter].surfaceArea, 4294967295.0);
+}